@@ -33,9 +33,10 @@ auto huffman_coding(
         btnode(size_t _freq) : node(_freq) {}
         btnode(char _c, size_t _freq) : node(_c, _freq), _enable(true) {}
     };
-    priority_queue<btnode*, vector<btnode*>, function<bool(const btnode*, const btnode*)>> _q([&](const btnode* _a, const btnode* _b) {
+    const function<bool(const btnode*, const btnode*)> _cmp = [](const btnode* _a, const btnode* _b) {
         return _a->_freq > _b->_freq;
-    });
+    };
+    priority_queue<btnode*, vector<btnode*>, function<bool(const btnode*, const btnode*)>> _q(_cmp);
     for (const auto& _i : _freq_table) {
         btnode* const _p = new btnode(_i.first, _i.second);
         _q.emplace(_p);
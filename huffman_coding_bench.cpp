@@ -0,0 +1,218 @@
+// g++ -std=c++17 -O2 huffman_coding_bench.cpp -o huffman_coding_bench
+// ./huffman_coding_bench [repeat] > huffman_coding_bench.csv
+
+#include "huffman_coding.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <limits>
+#include <new>
+#include <numeric>
+#include <random>
+#include <string>
+
+#include <malloc.h>
+
+using namespace std;
+
+// heap accounting, peak is reset before each case.
+static size_t _heap_cur = 0;
+static size_t _heap_peak = 0;
+
+// kept out of line, so gcc never sees free() paired with a new-expression.
+static void* heap_alloc(size_t _sz) __attribute__((noinline));
+static void heap_free(void* _p) noexcept __attribute__((noinline));
+
+static void* heap_alloc(size_t _sz) {
+    void* const _p = malloc(_sz == 0 ? 1 : _sz);
+    if (_p == nullptr) throw bad_alloc();
+    _heap_cur += malloc_usable_size(_p); _heap_peak = max(_heap_peak, _heap_cur);
+    return _p;
+}
+static void heap_free(void* _p) noexcept {
+    if (_p == nullptr) return;
+    _heap_cur -= malloc_usable_size(_p);
+    free(_p);
+}
+
+void* operator new(size_t _sz) { return heap_alloc(_sz); }
+void* operator new[](size_t _sz) { return heap_alloc(_sz); }
+void operator delete(void* _p) noexcept { heap_free(_p); }
+void operator delete[](void* _p) noexcept { heap_free(_p); }
+void operator delete(void* _p, size_t) noexcept { heap_free(_p); }
+void operator delete[](void* _p, size_t) noexcept { heap_free(_p); }
+
+struct dist_t {
+    const char* _name;
+    vector<double> _weight; // _weight[c] means relative frequency of byte c.
+};
+
+vector<dist_t> make_distributions();
+string generate(const dist_t& _d, size_t _n, uint32_t _seed);
+double entropy(const unordered_map<char, size_t>& _freq_table, size_t _n);
+void encode(const string& _s, const unordered_map<char, b_vec>& _code, vector<uint8_t>& _out, size_t& _nbits);
+void decode(const vector<uint8_t>& _in, size_t _nbits, const unordered_map<char, b_vec>& _code, string& _out);
+
+auto make_distributions() -> vector<dist_t> {
+    vector<dist_t> _ans;
+    { // english letters, space and a little punctuation
+        dist_t _d {"text", vector<double>(256, 0)};
+        const double _letter[26] = {
+            8.2, 1.5, 2.8, 4.3, 12.7, 2.2, 2.0, 6.1, 7.0, 0.15, 0.77, 4.0, 2.4,
+            6.7, 7.5, 1.9, 0.095, 6.0, 6.3, 9.1, 2.8, 0.98, 2.4, 0.15, 2.0, 0.074
+        };
+        for (size_t _i = 0; _i < 26; ++_i) {
+            _d._weight['a' + _i] = _letter[_i] * 0.95;
+            _d._weight['A' + _i] = _letter[_i] * 0.05;
+        }
+        _d._weight[' '] = 18.0; _d._weight['\n'] = 1.5;
+        _d._weight['.'] = 1.0; _d._weight[','] = 1.2;
+        _ans.emplace_back(move(_d));
+    }
+    { // zipf over 64 symbols
+        dist_t _d {"skewed", vector<double>(256, 0)};
+        for (size_t _i = 0; _i < 64; ++_i) {
+            _d._weight[_i] = 1.0 / ((_i + 1) * (_i + 1));
+        }
+        _ans.emplace_back(move(_d));
+    }
+    {
+        dist_t _d {"uniform", vector<double>(256, 1)};
+        _ans.emplace_back(move(_d));
+    }
+    { // object-code like, dominated by 0x00 and 0xff
+        dist_t _d {"binary", vector<double>(256, 0.4 / 256)};
+        _d._weight[0x00] += 0.5; _d._weight[0xff] += 0.1;
+        _ans.emplace_back(move(_d));
+    }
+    return _ans;
+}
+
+auto generate(const dist_t& _d, size_t _n, uint32_t _seed) -> string {
+    // only raw mt19937 output is used, so the corpus is identical on every platform.
+    mt19937 _gen(_seed);
+    vector<double> _cdf(256);
+    partial_sum(_d._weight.begin(), _d._weight.end(), _cdf.begin());
+    string _s(_n, '\0');
+    for (size_t _i = 0; _i < _n; ++_i) {
+        const double _r = _gen() / 4294967296.0 * _cdf.back();
+        const size_t _c = upper_bound(_cdf.begin(), _cdf.end(), _r) - _cdf.begin();
+        _s[_i] = static_cast<char>(min<size_t>(_c, 255));
+    }
+    return _s;
+}
+
+auto entropy(const unordered_map<char, size_t>& _freq_table, size_t _n) -> double {
+    double _h = 0;
+    for (const auto& _i : _freq_table) {
+        const double _p = _i.second / double(_n);
+        _h -= _p * log2(_p);
+    }
+    return _h;
+}
+
+auto encode(
+    const string& _s, const unordered_map<char, b_vec>& _code,
+    vector<uint8_t>& _out, size_t& _nbits
+) -> void {
+    const b_vec* _table[256] = {};
+    for (const auto& _i : _code) {
+        _table[static_cast<uint8_t>(_i.first)] = &_i.second;
+    }
+    _out.clear(); _nbits = 0;
+    uint8_t _acc = 0;
+    for (const char _c : _s) {
+        for (const bool _b : *_table[static_cast<uint8_t>(_c)]) {
+            _acc = (_acc << 1) | _b;
+            if ((++_nbits & 7) == 0) {
+                _out.push_back(_acc); _acc = 0;
+            }
+        }
+    }
+    if (_nbits & 7) {
+        _out.push_back(_acc << (8 - (_nbits & 7)));
+    }
+}
+
+auto decode(
+    const vector<uint8_t>& _in, size_t _nbits,
+    const unordered_map<char, b_vec>& _code, string& _out
+) -> void {
+    // flat binary trie, _trie[k][b] is the child of node k on bit b, leaves are ~c.
+    vector<array<int, 2>> _trie(1, {0, 0});
+    for (const auto& _i : _code) {
+        size_t _k = 0;
+        for (size_t _j = 0; _j < _i.second.size(); ++_j) {
+            const bool _b = _i.second[_j];
+            if (_j + 1 == _i.second.size()) {
+                _trie[_k][_b] = ~static_cast<int>(static_cast<uint8_t>(_i.first));
+            }
+            else {
+                if (_trie[_k][_b] == 0) {
+                    _trie[_k][_b] = _trie.size();
+                    _trie.push_back({0, 0});
+                }
+                _k = _trie[_k][_b];
+            }
+        }
+    }
+    _out.clear();
+    int _k = 0;
+    for (size_t _i = 0; _i < _nbits; ++_i) {
+        const bool _b = (_in[_i >> 3] >> (7 - (_i & 7))) & 1;
+        const int _next = _trie[_k][_b];
+        if (_next < 0) {
+            _out.push_back(static_cast<char>(~_next)); _k = 0;
+        }
+        else _k = _next;
+    }
+}
+
+template <typename _F> double best_ns(size_t _repeat, _F&& _f) {
+    double _best = numeric_limits<double>::max();
+    for (size_t _r = 0; _r < _repeat; ++_r) {
+        const auto _t0 = chrono::steady_clock::now();
+        _f();
+        const auto _t1 = chrono::steady_clock::now();
+        _best = min(_best, chrono::duration<double, nano>(_t1 - _t0).count());
+    }
+    return _best;
+}
+
+int main(int _argc, char** _argv) {
+    const size_t _repeat = (_argc > 1 ? strtoul(_argv[1], nullptr, 10) : 5);
+    const size_t _sizes[] = {1 << 10, 1 << 16, 1 << 20, 1 << 24};
+    cout << "dist,size,symbols,build_ns,encode_mbps,decode_mbps,bits_per_symbol,entropy,peak_heap_bytes,ok\n";
+    const auto _dists = make_distributions();
+    for (const auto& _d : _dists) {
+        for (const size_t _n : _sizes) {
+            const string _s = generate(_d, _n, 0x5eed ^ static_cast<uint32_t>(_n));
+            unordered_map<char, size_t> _freq_table;
+            for (const char _c : _s) ++_freq_table[_c];
+            _heap_peak = _heap_cur;
+            const size_t _base = _heap_cur;
+
+            unordered_map<char, b_vec> _code;
+            const double _build_ns = best_ns(_repeat, [&] { _code = huffman_coding(_freq_table); });
+            vector<uint8_t> _bits; size_t _nbits = 0;
+            const double _enc_ns = best_ns(_repeat, [&] { encode(_s, _code, _bits, _nbits); });
+            string _out;
+            const double _dec_ns = best_ns(_repeat, [&] { decode(_bits, _nbits, _code, _out); });
+            const size_t _peak = _heap_peak - _base;
+
+            cout << _d._name << ',' << _n << ',' << _freq_table.size() << ','
+                 << fixed << setprecision(0) << _build_ns << ','
+                 << setprecision(2) << _n / (_enc_ns / 1e3) << ','
+                 << _n / (_dec_ns / 1e3) << ','
+                 << setprecision(4) << _nbits / double(_n) << ','
+                 << entropy(_freq_table, _n) << ','
+                 << _peak << ',' << (_out == _s) << '\n';
+        }
+    }
+    return 0;
+}
@@ -4,12 +4,23 @@
 #include <algorithm>
 #include <cassert>
 #include <numeric>
+#include <stdexcept>
 #include <vector>
 
 #include <cstdio>
+#include <iostream>
 
 using namespace std;
 
+void knap_sack_merge(
+    const vector<size_t>& _wi,
+    const vector<size_t>& _vi,
+    size_t _weight,
+    size_t _value,
+    size_t _capacity,
+    vector<size_t>& _wI,
+    vector<size_t>& _vI
+);
 size_t knap_sack(
     const vector<size_t>& _weight,
     const vector<size_t>& _value,
@@ -21,6 +32,111 @@ void knap_sack_traceback(
     const vector<vector<size_t>>& _v
 );
 
+// all-capacities query index over the final JNS of knap_sack.
+// items form a queue kept as two stacks of JNS, front (oldest item on top) and back.
+// a stack running empty takes half of the other one and both are rebuilt,
+// so push, pop and pop_front merge O(1) items amortized, erase merges O(n).
+// the first query after a mutation merges the items of the stack holding fewer of them
+// into the final JNS of the other, later queries binary search the result.
+class knap_sack_index_t {
+public:
+    knap_sack_index_t(size_t _capacity);
+    knap_sack_index_t(
+        const vector<size_t>& _weight,
+        const vector<size_t>& _value,
+        size_t _capacity
+    );
+    // queries above capacity() throw out_of_range, plans heavier than it were never generated.
+    size_t query(size_t _c) const; // best value within capacity %_c
+    vector<size_t> query(const vector<size_t>& _cs) const;
+    vector<bool> selection(size_t _c) const; // items picked for query(_c), in queue order
+    void push(size_t _weight, size_t _value); // append an item as the newest
+    void pop(); // remove the newest item
+    void pop_front(); // remove the oldest item
+    void erase(size_t _k); // remove item %_k, merges the items stacked above it again
+    size_t items() const { return _front._weight.size() + _back._weight.size(); }
+    size_t capacity() const { return _capacity; }
+    size_t size() const { return _front.size() + _back.size(); } // plans in both final JNS
+    size_t nodes() const { return _front.nodes() + _back.nodes(); } // sum of |S_{i}| in both stacks
+
+private:
+    struct jns_t { // the same as _w and _v in knap_sack, for the items of one stack
+        jns_t() : _w(1, vector<size_t>(1, 0)), _v(1, vector<size_t>(1, 0)) {}
+        void push(size_t _weight, size_t _value, size_t _capacity);
+        void pop();
+        void erase(size_t _k, size_t _capacity);
+        void clear() { *this = jns_t(); }
+        size_t position(size_t _c) const; // index of the plan in S_{n} answering %_c
+        void traceback(size_t _j, vector<bool>& _picked) const; // items of plan %_j in S_{n}
+        size_t size() const { return _w.back().size(); }
+        size_t nodes() const;
+        vector<size_t> _weight;
+        vector<size_t> _value;
+        vector<vector<size_t>> _w;
+        vector<vector<size_t>> _v;
+    };
+    struct plan_t { // a plan of the whole queue, made of plan %_f in final front and %_b in final back
+        size_t _w;
+        size_t _v;
+        size_t _f;
+        size_t _b;
+    };
+    void rebalance(size_t _m); // rebuild with the oldest %_m items in front, the others in back
+    const vector<plan_t>& combined() const; // final JNS of the whole queue
+    pair<size_t, size_t> split(size_t _c) const; // best plans of front and back within %_c
+
+    size_t _capacity;
+    jns_t _front; // items pushed in reverse order, the oldest item is the last one
+    jns_t _back;
+    mutable vector<plan_t> _plans; // cache of combined(), valid unless %_stale
+    mutable bool _stale = true;
+};
+
+
+auto knap_sack_merge(
+    const vector<size_t>& _wi,
+    const vector<size_t>& _vi,
+    size_t _weight,
+    size_t _value,
+    size_t _capacity,
+    vector<size_t>& _wI,
+    vector<size_t>& _vI
+) -> void { // S_{i} -> S_{i+1}, with item <_weight, _value>
+    // traverse _wi and _vi
+    assert(_wi.size() == _vi.size());
+    const size_t _ni = _wi.size(); // size of S_{i}
+    size_t _k = 0; // index of nodes in S_{i}, which could appear in next JNS.
+    _wI.clear(); _vI.clear(); // JNS
+    for (size_t _j = 0; _j < _ni; ++_j) { // traverse S_{i} to generate P
+        // calculate the position of each node in S_{i} where they could appear in next JNS.
+        // %<_wsi, _vsi> = P
+        const size_t _wsi = _wi[_j] + _weight; // total weight if selected
+        if (_wsi > _capacity) break; // overloaded
+        size_t _vsi = _vi[_j] + _value; // total value if selected
+        while (_k < _ni && _wi[_k] < _wsi) { // nodes in S_{i} on the left of P, they have chance to appear in next JNS.
+            _wI.emplace_back(_wi[_k]);
+            _vI.emplace_back(_vi[_k]);
+            ++_k;
+        }
+        if (_k < _ni && _wi[_k] == _wsi) { // node in S_{i}, which has the same weight with P, update P if necessary
+            _vsi = max(_vsi, _vi[_k]);
+            ++_k;
+        }
+        if (_vI.empty() || _vsi > _vI.back()) { // insert P into next JNS
+            _wI.emplace_back(_wsi);
+            _vI.emplace_back(_vsi);
+        }
+        // all nodes on the lower right corner of P would be eliminated
+        while (_k < _ni && _vi[_k] < _vI.back()) { // _vI can't be empty
+            ++_k;
+        }
+    }
+    while (_k < _ni) { // insert remained nodes in S_{i} into JNS
+        _wI.emplace_back(_wi[_k]);
+        _vI.emplace_back(_vi[_k]);
+        ++_k;
+    }
+}
 
 auto knap_sack(
     const vector<size_t>& _weight,
@@ -36,41 +152,7 @@ auto knap_sack(
     _w[0].emplace_back(0); _v[0].emplace_back(0);
 
     for (size_t _i = 0; _i < _n; ++_i) { // S_{i} -> S_{i+1}
-        // traverse _w[_i] and _v[_i]
-        auto& _wi = _w[_i]; auto& _vi = _v[_i];
-        assert(_wi.size() == _vi.size());
-        const size_t _ni = _wi.size(); // size of S_{i}
-        size_t _k = 0; // index of nodes in S_{i}, which could appear in next JNS.
-        auto& _wI = _w[_i+1]; auto& _vI = _v[_i+1]; // JNS
-        for (size_t _j = 0; _j < _ni; ++_j) { // traverse S_{i} to generate P
-            // calculate the position of each node in S_{i} where they could appear in next JNS.
-            // %<_wsi, _vsi> = P
-            const size_t _wsi = _wi[_j] + _weight[_i]; // total weight if selected %_i
-            if (_wsi > _capacity) break; // overloaded
-            size_t _vsi = _vi[_j] + _value[_i]; // total value if selected %_i
-            while (_k < _ni && _wi[_k] < _wsi) { // nodes in S_{i} on the left of P, they have chance to appear in next JNS.
-                _wI.emplace_back(_wi[_k]);
-                _vI.emplace_back(_vi[_k]);
-                ++_k;
-            }
-            if (_k < _ni && _wi[_k] == _wsi) { // node in S_{i}, which has the same weight with P, update P if necessary
-                _vsi = max(_vsi, _vi[_k]);
-                ++_k;
-            }
-            if (_vI.empty() || _vsi > _vI.back()) { // insert P into next JNS
-                _wI.emplace_back(_wsi);
-                _vI.emplace_back(_vsi);
-            }
-            // all nodes on the lower right corner of P would be eliminated
-            while (_k < _ni && _vi[_k] < _vI.back()) { // _vI can't be empty
-                ++_k;
-            }
-        }
-        while (_k < _ni) { // insert remained nodes in S_{i} into JNS
-            _wI.emplace_back(_wi[_k]);
-            _vI.emplace_back(_vi[_k]);
-            ++_k;
-        }
+        knap_sack_merge(_w[_i], _v[_i], _weight[_i], _value[_i], _capacity, _w[_i+1], _v[_i+1]);
     }
     knap_sack_traceback(_weight, _w, _v);
     return _v[_n].back();
@@ -98,7 +180,7 @@ auto knap_sack_traceback(
         const auto& _wi = _w[_i];
         const auto& _vi = _v[_i];
         assert(_wi.size() == _vi.size() && !_wi.empty());
-        if (_wx == -1) _wx = _wi.back();
+        if (_wx == size_t(-1)) _wx = _wi.back();
         if (!find(_wx, _i-1)) {
             _serial[_i-1] = 1;
             _wx -= _weight[_i-1];
@@ -117,4 +199,210 @@ auto knap_sack_traceback(
     }
     cout << "]." << endl;
 }
+
+auto knap_sack_index_t::jns_t::push(size_t _weight, size_t _value, size_t _capacity) -> void {
+    const size_t _n = this->_weight.size();
+    this->_weight.emplace_back(_weight); this->_value.emplace_back(_value);
+    _w.emplace_back(); _v.emplace_back();
+    knap_sack_merge(_w[_n], _v[_n], _weight, _value, _capacity, _w[_n+1], _v[_n+1]);
+}
+
+auto knap_sack_index_t::jns_t::pop() -> void {
+    assert(!_weight.empty());
+    _weight.pop_back(); _value.pop_back();
+    _w.pop_back(); _v.pop_back();
+}
+
+auto knap_sack_index_t::jns_t::erase(size_t _k, size_t _capacity) -> void {
+    assert(_k < _weight.size());
+    _weight.erase(_weight.begin() + _k); _value.erase(_value.begin() + _k);
+    _w.pop_back(); _v.pop_back();
+    // S_{0..k} are unaffected, rebuild S_{k+1..n} from checkpoint S_{k}.
+    const size_t _n = _weight.size();
+    for (size_t _i = _k; _i < _n; ++_i) {
+        knap_sack_merge(_w[_i], _v[_i], _weight[_i], _value[_i], _capacity, _w[_i+1], _v[_i+1]);
+    }
+}
+
+auto knap_sack_index_t::jns_t::position(size_t _c) const -> size_t {
+    const auto& _wn = _w.back();
+    // <0, 0> is always in S_{n}, so the plan exists.
+    return upper_bound(_wn.begin(), _wn.end(), _c) - _wn.begin() - 1;
+}
+
+auto knap_sack_index_t::jns_t::traceback(size_t _j, vector<bool>& _picked) const -> void {
+    const size_t _n = _weight.size();
+    _picked.assign(_n, false);
+    size_t _wx = _w[_n][_j]; size_t _vx = _v[_n][_j]; // plan <_wx, _vx> in S_{i}
+    for (size_t _i = _n; _i > 0; --_i) {
+        // the plan is kept from S_{i-1} unchanged, or generated by picking %_i-1.
+        const auto& _wi = _w[_i-1]; const auto& _vi = _v[_i-1];
+        const auto _it = lower_bound(_wi.begin(), _wi.end(), _wx);
+        if (_it != _wi.end() && *_it == _wx && _vi[_it - _wi.begin()] == _vx) {
+            continue;
+        }
+        assert(_wx >= _weight[_i-1] && _vx >= _value[_i-1]);
+        _picked[_i-1] = true;
+        _wx -= _weight[_i-1]; _vx -= _value[_i-1];
+    }
+    assert(_wx == 0 && _vx == 0);
+}
+
+auto knap_sack_index_t::jns_t::nodes() const -> size_t {
+    size_t _ans = 0;
+    for (const auto& _wi : _w) {
+        _ans += _wi.size();
+    }
+    return _ans;
+}
+
+knap_sack_index_t::knap_sack_index_t(size_t _capacity) : _capacity(_capacity) {}
+
+knap_sack_index_t::knap_sack_index_t(
+    const vector<size_t>& _weight,
+    const vector<size_t>& _value,
+    size_t _capacity
+) : knap_sack_index_t(_capacity) {
+    assert(_weight.size() == _value.size());
+    const size_t _n = _weight.size();
+    _back._weight.reserve(_n); _back._value.reserve(_n);
+    _back._w.reserve(_n+1); _back._v.reserve(_n+1);
+    for (size_t _i = 0; _i < _n; ++_i) {
+        push(_weight[_i], _value[_i]);
+    }
+}
+
+auto knap_sack_index_t::push(size_t _weight, size_t _value) -> void {
+    _stale = true;
+    _back.push(_weight, _value, _capacity);
+}
+
+auto knap_sack_index_t::pop() -> void {
+    assert(items() != 0);
+    _stale = true;
+    if (_back._weight.empty()) { // the newest item is at the bottom of front
+        rebalance(items() / 2);
+    }
+    _back.pop();
+}
+
+auto knap_sack_index_t::pop_front() -> void {
+    assert(items() != 0);
+    _stale = true;
+    if (_front._weight.empty()) { // the oldest item is at the bottom of back
+        rebalance((items() + 1) / 2);
+    }
+    _front.pop();
+}
+
+auto knap_sack_index_t::rebalance(size_t _m) -> void {
+    // only called when one stack is empty, so each half is left with at least n/2 items
+    // to pop before the next O(n) rebuild.
+    vector<size_t> _weight(_front._weight.rbegin(), _front._weight.rend()); // queue order
+    vector<size_t> _value(_front._value.rbegin(), _front._value.rend());
+    _weight.insert(_weight.end(), _back._weight.begin(), _back._weight.end());
+    _value.insert(_value.end(), _back._value.begin(), _back._value.end());
+    assert(_m <= _weight.size());
+    _front.clear(); _back.clear();
+    for (size_t _i = _m; _i > 0; --_i) {
+        _front.push(_weight[_i-1], _value[_i-1], _capacity);
+    }
+    for (size_t _i = _m; _i < _weight.size(); ++_i) {
+        _back.push(_weight[_i], _value[_i], _capacity);
+    }
+}
+
+auto knap_sack_index_t::erase(size_t _k) -> void {
+    assert(_k < items());
+    _stale = true;
+    const size_t _nf = _front._weight.size();
+    if (_k < _nf) {
+        _front.erase(_nf - 1 - _k, _capacity);
+    }
+    else {
+        _back.erase(_k - _nf, _capacity);
+    }
+}
+
+auto knap_sack_index_t::combined() const -> const vector<plan_t>& {
+    if (!_stale) return _plans;
+    // knap_sack_merge over S_{n} of the larger stack, each plan keeps the plan of that stack it grew from.
+    const bool _swap = _front._weight.size() < _back._weight.size(); // %_s holds fewer items
+    const jns_t& _l = (_swap ? _back : _front); const jns_t& _s = (_swap ? _front : _back);
+    const auto& _wl = _l._w.back(); const auto& _vl = _l._v.back();
+    _plans.clear();
+    for (size_t _k = 0; _k < _wl.size(); ++_k) {
+        _plans.push_back({_wl[_k], _vl[_k], _k, 0});
+    }
+    vector<plan_t> _next;
+    for (size_t _i = 0; _i < _s._weight.size(); ++_i) {
+        const size_t _weight = _s._weight[_i]; const size_t _value = _s._value[_i];
+        const size_t _nk = (_weight > _capacity ? 0 : upper_bound( // plans still fitting with %_i
+            _plans.begin(), _plans.end(), _capacity - _weight,
+            [](size_t _x, const plan_t& _q) { return _x < _q._w; }
+        ) - _plans.begin());
+        size_t _j = 0; size_t _k = 0; // next plan kept as is, and next plan picking %_i
+        _next.clear();
+        while (_j < _plans.size() || _k < _nk) {
+            plan_t _p;
+            if (_k == _nk || (_j < _plans.size() && _plans[_j]._w <= _plans[_k]._w + _weight)) {
+                _p = _plans[_j++];
+            }
+            else {
+                _p = _plans[_k++]; _p._w += _weight; _p._v += _value;
+            }
+            if (!_next.empty() && _p._v <= _next.back()._v) continue; // dominated
+            if (!_next.empty() && _p._w == _next.back()._w) {
+                _next.back() = _p;
+            }
+            else {
+                _next.emplace_back(_p);
+            }
+        }
+        _plans.swap(_next);
+    }
+    // the rest of a plan is undominated among the items of %_s, so it is a plan of S_{n} there.
+    for (auto& _p : _plans) {
+        _p._b = _s.position(_p._w - _wl[_p._f]);
+        assert(_s._w.back()[_p._b] + _wl[_p._f] == _p._w && _s._v.back()[_p._b] + _vl[_p._f] == _p._v);
+        if (_swap) swap(_p._f, _p._b);
+    }
+    _stale = false;
+    return _plans;
+}
+
+auto knap_sack_index_t::split(size_t _c) const -> pair<size_t, size_t> {
+    if (_c > _capacity) {
+        throw out_of_range("knap_sack_index_t: query above capacity");
+    }
+    const auto& _p = combined();
+    // <0, 0> is always combined, so the plan exists.
+    const auto _it = upper_bound(
+        _p.begin(), _p.end(), _c, [](size_t _x, const plan_t& _q) { return _x < _q._w; }
+    ) - 1;
+    return {_it->_f, _it->_b};
+}
+
+auto knap_sack_index_t::query(size_t _c) const -> size_t {
+    const auto _p = split(_c);
+    return _front._v.back()[_p.first] + _back._v.back()[_p.second];
+}
+
+auto knap_sack_index_t::query(const vector<size_t>& _cs) const -> vector<size_t> {
+    vector<size_t> _ans; _ans.reserve(_cs.size());
+    for (const auto _c : _cs) {
+        _ans.emplace_back(query(_c));
+    }
+    return _ans;
+}
+
+auto knap_sack_index_t::selection(size_t _c) const -> vector<bool> {
+    const auto _p = split(_c);
+    vector<bool> _pf; vector<bool> _pb;
+    _front.traceback(_p.first, _pf); _back.traceback(_p.second, _pb);
+    vector<bool> _ans(_pf.rbegin(), _pf.rend()); // front is stacked newest first
+    _ans.insert(_ans.end(), _pb.begin(), _pb.end());
+    return _ans;
+}
+
 #endif // _KNAPSACK_HPP_
\ No newline at end of file
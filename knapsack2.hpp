@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <functional>
 #include <queue>
 #include <numeric>
 #include <vector>
@@ -16,18 +17,56 @@ void value_density_sort(
     vector<size_t>& _weight,
     vector<size_t>& _value
 );
+vector<size_t> value_density_order(
+    const vector<size_t>& _weight,
+    const vector<size_t>& _value
+);
 
 size_t knap_sack2(
     const vector<size_t>& _weight,
     const vector<size_t>& _value,
     size_t _capacity
 );
+size_t knap_sack2(
+    const vector<size_t>& _weight,
+    const vector<size_t>& _value,
+    size_t _capacity,
+    vector<bool>& _selection,
+    size_t* _nodes = nullptr // number of search nodes generated
+);
+size_t knap_sack2_core(
+    const vector<size_t>& _weight,
+    const vector<size_t>& _value,
+    size_t _capacity,
+    vector<bool>& _selection,
+    size_t* _nodes = nullptr // number of search nodes generated
+);
 
 auto knap_sack2(
     const vector<size_t>& _weight,
     const vector<size_t>& _value,
     size_t _capacity
 ) -> size_t {
+    const size_t _n = _weight.size();
+    vector<bool> _selection;
+    const size_t _total_value = knap_sack2(_weight, _value, _capacity, _selection);
+    cout << '[';
+    for (size_t _i = 0; _i != _n;) {
+        cout << _selection[_i++];
+        if (_i != _n) cout << ", ";
+    }
+    cout << ']' << endl;
+    return _total_value;
+}
+
+auto knap_sack2(
+    const vector<size_t>& _weight,
+    const vector<size_t>& _value,
+    size_t _capacity,
+    vector<bool>& _selection,
+    size_t* _nodes
+) -> size_t { // items should be sorted by value density, see value_density_sort
+    typedef unsigned __int128 wide_type; // _cc * _value[_i] may not fit in size_t
     const size_t _n = _weight.size();
     const size_t _epsilon = 1;
     size_t _max_value = 0; // max value we've reached
@@ -40,7 +79,7 @@ auto knap_sack2(
         size_t _cub; // current upper bound
         size_t _i; // serial number
         node(size_t _c, size_t _v, size_t _i, size_t _clb, size_t _cub)
-         : _cc(_c), _cv(_v), _i(_i), _clb(_clb), _cub(_cub) {}
+         : _cc(_c), _cv(_v), _clb(_clb), _cub(_cub), _i(_i) {}
     };
     struct btnode : public node {
         btnode* _left = nullptr; // picked
@@ -52,7 +91,7 @@ auto knap_sack2(
         _pred_vl = _cv;
         for (size_t _i = _k; _i < _n; ++_i) {
             if (_cc < _weight[_i]) { // can't pick a complete item
-                _pred_vu = _pred_vl + _cc * _value[_i] / float(_weight[_i]);
+                _pred_vu = _pred_vl + size_t(wide_type(_cc) * _value[_i] / _weight[_i]); // floor is enough for integral values
                 for (size_t _j = _i + 1; _j < _n; ++_j) {
                     if (_cc >= _weight[_j]) {
                         _cc -= _weight[_j]; _pred_vl += _value[_j];
@@ -65,16 +104,16 @@ auto knap_sack2(
         _pred_vu = _pred_vl;
         assert(_pred_vu >= _pred_vl);
     };
-    priority_queue<btnode*, vector<btnode*>, function<bool(const btnode*, const btnode*)>> _q(
-        [&](const btnode* _a, const btnode* _b) -> bool {
-            return _a->_cub < _b->_cub;
-        }
-    );
+    const function<bool(const btnode*, const btnode*)> _cmp = [](const btnode* _a, const btnode* _b) -> bool {
+        return _a->_cub < _b->_cub;
+    };
+    priority_queue<btnode*, vector<btnode*>, function<bool(const btnode*, const btnode*)>> _q(_cmp);
     predict_bound(_capacity, 0, 0);
     _max_value = (_pred_vl <= _epsilon ? 0 : _pred_vl - _epsilon);
     btnode _root(_capacity, 0, 0, _pred_vl, _pred_vu);
     _q.emplace(&_root);
     btnode* _ans_node = nullptr;
+    size_t _generated = 1;
     while (!_q.empty()) {
         auto* const _p = _q.top(); _q.pop();
         if (_p->_cub <= _max_value) break;
@@ -85,6 +124,7 @@ auto knap_sack2(
         size_t _cap = _p->_cc; size_t _val = _p->_cv; btnode* _s = nullptr;
         if (_cap >= _weight[_i]) { // could pick _i
             _s = new btnode(_cap - _weight[_i], _val + _value[_i], _i+1, _p->_clb, _p->_cub);
+            ++_generated;
             _p->_left = _s; _s->_parent = _p;
             _q.emplace(_s);
         }
@@ -92,29 +132,26 @@ auto knap_sack2(
         predict_bound(_cap, _val, _i+1);
         if (_pred_vu > _max_value) {
             _s = new btnode(_cap, _val, _i+1, _pred_vl, _pred_vu);
+            ++_generated;
             _p->_right = _s; _s->_parent = _p;
             _max_value = max(_max_value, (_pred_vl <= _epsilon ? 0 : _pred_vl - _epsilon));
             _q.emplace(_s);
         }
     }
     auto traceback = [&](const btnode* _s) -> size_t {
-        if (_ans_node == nullptr) return 0;
-        assert(_ans_node->_i == _n);
-        vector<bool> _vb; _vb.reserve(_n);
+        _selection.assign(_n, false);
+        if (_s == nullptr) return 0;
+        assert(_s->_i == _n);
         size_t _total_value = 0;
-        for (btnode* _p = _ans_node; _p != nullptr && _p->_i != 0; _p = _p->_parent) {
-            btnode* const _pp = _p->_parent;
-            _vb[_pp->_i] = (_pp->_left == _p);
+        for (const btnode* _p = _s; _p != nullptr && _p->_i != 0; _p = _p->_parent) {
+            const btnode* const _pp = _p->_parent;
+            _selection[_pp->_i] = (_pp->_left == _p);
         }
-        cout << '[';
-        for (size_t _i = 0; _i != _n;) {
-            if (_vb[_i]) {
+        for (size_t _i = 0; _i != _n; ++_i) {
+            if (_selection[_i]) {
                 _total_value += _value[_i];
             }
-            cout << _vb[_i++];
-            if (_i != _n) cout << ", ";
         }
-        cout << ']' << endl;
         return _total_value;
     };
     function<void(btnode*)> dfs = [&](btnode* _p) {
@@ -124,20 +161,124 @@ auto knap_sack2(
     };
     auto _total_value = traceback(_ans_node);
     dfs(&_root);
+    if (_nodes != nullptr) *_nodes = _generated;
     return _total_value;
 };
 
+auto knap_sack2_core(
+    const vector<size_t>& _weight,
+    const vector<size_t>& _value,
+    size_t _capacity,
+    vector<bool>& _selection,
+    size_t* _nodes
+) -> size_t { // inputs needn't be sorted, %_selection is indexed as the inputs
+    assert(_weight.size() == _value.size());
+    typedef unsigned __int128 wide_type;
+    const size_t _n = _weight.size();
+    const auto _order = value_density_order(_weight, _value); // position -> item
+    auto w = [&](size_t _k) { return _weight[_order[_k]]; };
+    auto v = [&](size_t _k) { return _value[_order[_k]]; };
+    vector<size_t> _sw(_n+1, 0); vector<size_t> _sv(_n+1, 0); // prefix sums in density order
+    for (size_t _k = 0; _k < _n; ++_k) {
+        _sw[_k+1] = _sw[_k] + w(_k); _sv[_k+1] = _sv[_k] + v(_k);
+    }
+    // items in [0, _b) fit, %_b is the break item.
+    const size_t _b = upper_bound(_sw.begin(), _sw.end(), _capacity) - _sw.begin() - 1;
+
+    // greedy lower bound
+    size_t _lb = _sv[_b]; size_t _cc = _capacity - _sw[_b];
+    vector<bool> _greedy(_n, false);
+    for (size_t _k = 0; _k < _n; ++_k) {
+        if (_k < _b) _greedy[_k] = true;
+        else if (w(_k) <= _cc) {
+            _greedy[_k] = true; _cc -= w(_k); _lb += v(_k);
+        }
+    }
+    // dantzig bound with capacity %_cap, ignoring the item at position %_s
+    auto dantzig_bound = [&](size_t _cap, size_t _s) -> size_t {
+        auto sw = [&](size_t _k) { return _sw[_k] - (_s < _k ? w(_s) : 0); };
+        auto sv = [&](size_t _k) { return _sv[_k] - (_s < _k ? v(_s) : 0); };
+        size_t _lo = 0; size_t _hi = _n; // max %_k that sw(_k) <= _cap
+        while (_lo < _hi) {
+            const size_t _mid = (_lo + _hi + 1) / 2;
+            if (sw(_mid) <= _cap) _lo = _mid;
+            else _hi = _mid - 1;
+        }
+        size_t _ub = sv(_lo);
+        if (_lo < _n) { // _lo != _s, or _lo + 1 would fit too
+            _ub += wide_type(_cap - sw(_lo)) * v(_lo) / w(_lo);
+        }
+        return _ub;
+    };
+    // reduction, a plan better than %_lb must follow the fixed items.
+    vector<bool> _fixed(_n, false);
+    size_t _fixed_weight = 0; size_t _fixed_value = 0;
+    vector<size_t> _core; // positions of free items
+    for (size_t _k = 0; _k < _n; ++_k) {
+        if (_k < _b) {
+            if (dantzig_bound(_capacity, _k) <= _lb) { // fixed in
+                _fixed[_k] = true;
+                _fixed_weight += w(_k); _fixed_value += v(_k);
+                continue;
+            }
+        }
+        else {
+            if (w(_k) > _capacity || v(_k) + dantzig_bound(_capacity - w(_k), _k) <= _lb) { // fixed out
+                _fixed[_k] = true;
+                continue;
+            }
+        }
+        _core.emplace_back(_k);
+    }
+    // branch and bound over the core, which is already sorted by value density.
+    vector<size_t> _cw; vector<size_t> _cv;
+    _cw.reserve(_core.size()); _cv.reserve(_core.size());
+    for (const auto _k : _core) {
+        _cw.emplace_back(w(_k)); _cv.emplace_back(v(_k));
+    }
+    vector<bool> _cs;
+    const size_t _total_value = _fixed_value + knap_sack2(_cw, _cv, _capacity - _fixed_weight, _cs, _nodes);
+    _selection.assign(_n, false);
+    if (_total_value < _lb) { // greedy is optimal
+        for (size_t _k = 0; _k < _n; ++_k) {
+            _selection[_order[_k]] = _greedy[_k];
+        }
+        return _lb;
+    }
+    for (size_t _k = 0; _k < _b; ++_k) {
+        if (_fixed[_k]) _selection[_order[_k]] = true;
+    }
+    for (size_t _i = 0; _i < _core.size(); ++_i) {
+        _selection[_order[_core[_i]]] = _cs[_i];
+    }
+    return _total_value;
+}
+
+auto value_density_order(
+    const vector<size_t>& _weight,
+    const vector<size_t>& _value
+) -> vector<size_t> {
+    assert(_weight.size() == _value.size());
+    typedef unsigned __int128 wide_type;
+    vector<size_t> _indices(_weight.size(), 0);
+    iota(_indices.begin(), _indices.end(), 0);
+    // v_a / w_a > v_b / w_b, cross-multiplied to stay exact
+    stable_sort(_indices.begin(), _indices.end(), [&](const auto& _a, const auto& _b) {
+        if ((_weight[_a] == 0) != (_weight[_b] == 0)) { // weightless items first, 0/0 included
+            return _weight[_a] == 0;
+        }
+        return wide_type(_value[_a]) * _weight[_b] > wide_type(_value[_b]) * _weight[_a];
+    });
+    return _indices;
+}
+
 auto value_density_sort(
     vector<size_t>& _weight,
     vector<size_t>& _value
 ) -> void {
     assert(_weight.size() == _value.size());
     const size_t _n = _weight.size();
-    vector<size_t> _indices(_n, 0);
-    iota(_indices.begin(), _indices.end(), 0);
-    sort(_indices.begin(), _indices.end(), [&](const auto& _a, const auto& _b) {
-        return _value[_a] / (float)_weight[_a] > _value[_b] / (float)_weight[_b];
-    });
+    const vector<size_t> _indices = value_density_order(_weight, _value);
     vector<bool> _placed(_n, false);
     for (size_t _i = 0; _i != _n; ++_i) {
         if (_placed[_i]) continue;
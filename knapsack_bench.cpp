@@ -0,0 +1,206 @@
+// g++ -std=c++17 -O2 knapsack_bench.cpp -o knapsack_bench
+// ./knapsack_bench [timeout_s] [memory_mb] > knapsack_bench.csv
+
+#include "knapsack.hpp"
+#include "knapsack2.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <random>
+#include <string>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+struct instance_t {
+    string _class;
+    size_t _range; // coefficients are drawn from [1, _range]
+    vector<size_t> _weight;
+    vector<size_t> _value;
+    size_t _capacity;
+};
+
+struct result_t {
+    size_t _value = 0;
+    size_t _work = 0; // jump nodes or search nodes, 0 if unknown
+    double _ms = 0;
+};
+
+typedef function<result_t(const instance_t&)> engine_type;
+
+instance_t generate(const string& _class, size_t _n, size_t _range, size_t _h, size_t _seed);
+bool run_isolated(const engine_type& _f, const instance_t& _d, unsigned _timeout, size_t _memory_mb, result_t& _r, string& _status, long& _rss_kb);
+
+auto generate(
+    const string& _class, size_t _n, size_t _range, size_t _h, size_t _seed
+) -> instance_t {
+    // pisinger's classes, capacity is the %_h-th of 100 fractions of total weight.
+    // only raw mt19937_64 output is used, so instances are identical on every platform.
+    mt19937_64 _gen(_seed);
+    auto uniform = [&](size_t _lo, size_t _hi) -> size_t { return _lo + _gen() % (_hi - _lo + 1); };
+    const size_t _r10 = _range / 10;
+    instance_t _d {_class, _range, vector<size_t>(_n), vector<size_t>(_n), 0};
+    if (_class == "spanner") { // spanner(2, 10) over strongly correlated items
+        const size_t _v = 2; const size_t _m = 10;
+        vector<size_t> _sw(_v); vector<size_t> _sv(_v);
+        for (size_t _k = 0; _k < _v; ++_k) {
+            const size_t _w = uniform(1, _range);
+            _sw[_k] = (2 * _w + _m - 1) / _m; _sv[_k] = (2 * (_w + _r10) + _m - 1) / _m;
+        }
+        for (size_t _i = 0; _i < _n; ++_i) {
+            const size_t _k = uniform(0, _v - 1); const size_t _a = uniform(1, _m);
+            _d._weight[_i] = _a * _sw[_k]; _d._value[_i] = _a * _sv[_k];
+        }
+    }
+    else for (size_t _i = 0; _i < _n; ++_i) {
+        size_t& _w = _d._weight[_i]; size_t& _p = _d._value[_i];
+        if (_class == "uncorrelated") {
+            _w = uniform(1, _range); _p = uniform(1, _range);
+        }
+        else if (_class == "weakly_correlated") {
+            _w = uniform(1, _range); _p = uniform(_w > _r10 ? _w - _r10 : 1, _w + _r10);
+        }
+        else if (_class == "strongly_correlated") {
+            _w = uniform(1, _range); _p = _w + _r10;
+        }
+        else if (_class == "inverse_strongly_correlated") {
+            _p = uniform(1, _range); _w = _p + _r10;
+        }
+        else if (_class == "subset_sum") {
+            _w = uniform(1, _range); _p = _w;
+        }
+        else assert(false);
+    }
+    const size_t _sum = accumulate(_d._weight.begin(), _d._weight.end(), size_t(0));
+    _d._capacity = _sum * _h / 101;
+    return _d;
+}
+
+auto run_isolated(
+    const engine_type& _f, const instance_t& _d, unsigned _timeout, size_t _memory_mb,
+    result_t& _r, string& _status, long& _rss_kb
+) -> bool {
+    // each run gets its own process, so a hung or exploding engine is killed and peak rss is its own.
+    int _fd[2];
+    if (pipe(_fd) != 0) return false;
+    cout.flush();
+    const pid_t _pid = fork();
+    if (_pid < 0) return false;
+    if (_pid == 0) {
+        close(_fd[0]);
+        rlimit _rl; _rl.rlim_cur = _rl.rlim_max = _memory_mb << 20;
+        setrlimit(RLIMIT_AS, &_rl);
+        alarm(_timeout);
+        cout.rdbuf(nullptr); // knap_sack and knap_sack2 print their selection
+        const int _null = open("/dev/null", O_WRONLY); // failures are reported by the status column
+        if (_null >= 0) {
+            dup2(_null, STDERR_FILENO); close(_null);
+        }
+        const result_t _res = _f(_d);
+        const ssize_t _written = write(_fd[1], &_res, sizeof(_res));
+        _exit(_written == sizeof(_res) ? 0 : 1);
+    }
+    close(_fd[1]);
+    int _wstatus = 0; rusage _ru;
+    wait4(_pid, &_wstatus, 0, &_ru);
+    const ssize_t _read = read(_fd[0], &_r, sizeof(_r));
+    close(_fd[0]);
+    _rss_kb = _ru.ru_maxrss;
+    if (WIFEXITED(_wstatus) && WEXITSTATUS(_wstatus) == 0 && _read == sizeof(_r)) {
+        _status = "ok";
+    }
+    else if (WIFSIGNALED(_wstatus) && WTERMSIG(_wstatus) == SIGALRM) {
+        _status = "timeout";
+    }
+    else if (WIFSIGNALED(_wstatus) && WTERMSIG(_wstatus) == SIGABRT) {
+        _status = "abort"; // bad_alloc under the memory limit, mostly
+    }
+    else {
+        _status = "failed";
+    }
+    return _status == "ok";
+}
+
+template <typename _F> result_t timed(_F&& _f) {
+    result_t _r;
+    const auto _t0 = chrono::steady_clock::now();
+    _f(_r);
+    const auto _t1 = chrono::steady_clock::now();
+    _r._ms = chrono::duration<double, milli>(_t1 - _t0).count();
+    return _r;
+}
+
+int main(int _argc, char** _argv) {
+    const unsigned _timeout = (_argc > 1 ? strtoul(_argv[1], nullptr, 10) : 5);
+    const size_t _memory_mb = (_argc > 2 ? strtoul(_argv[2], nullptr, 10) : 2048);
+    const vector<pair<string, engine_type>> _engines {
+        {"knap_sack", [](const instance_t& _d) {
+            return timed([&](result_t& _r) { _r._value = knap_sack(_d._weight, _d._value, _d._capacity); });
+        }},
+        {"knap_sack_index", [](const instance_t& _d) {
+            return timed([&](result_t& _r) {
+                knap_sack_index_t _ix(_d._weight, _d._value, _d._capacity);
+                _r._value = _ix.query(_d._capacity); _r._work = _ix.nodes();
+            });
+        }},
+        {"knap_sack2", [](const instance_t& _d) { // density sort is part of the cost
+            return timed([&](result_t& _r) {
+                vector<size_t> _weight = _d._weight; vector<size_t> _value = _d._value;
+                value_density_sort(_weight, _value);
+                vector<bool> _selection;
+                _r._value = knap_sack2(_weight, _value, _d._capacity, _selection, &_r._work);
+            });
+        }},
+        {"knap_sack2_core", [](const instance_t& _d) {
+            return timed([&](result_t& _r) {
+                vector<bool> _selection;
+                _r._value = knap_sack2_core(_d._weight, _d._value, _d._capacity, _selection, &_r._work);
+            });
+        }},
+    };
+    const char* const _classes[] = {
+        "uncorrelated", "weakly_correlated", "strongly_correlated",
+        "inverse_strongly_correlated", "subset_sum", "spanner"
+    };
+    const size_t _sizes[] = {50, 200, 1000};
+    const size_t _ranges[] = {1000, 10000};
+    const size_t _fractions[] = {25, 50}; // capacity, in 1/101 of total weight
+
+    cout << "class,n,range,capacity,engine,status,value,agree,wall_ms,peak_rss_kb,work\n";
+    size_t _seed = 0;
+    for (const char* _class : _classes) {
+        for (const size_t _n : _sizes) {
+            for (const size_t _range : _ranges) {
+                for (const size_t _h : _fractions) {
+                    const instance_t _d = generate(_class, _n, _range, _h, ++_seed);
+                    bool _has_ref = false; size_t _ref = 0;
+                    for (const auto& _e : _engines) {
+                        result_t _r; string _status; long _rss_kb = 0;
+                        const bool _ok = run_isolated(_e.second, _d, _timeout, _memory_mb, _r, _status, _rss_kb);
+                        if (_ok && !_has_ref) {
+                            _has_ref = true; _ref = _r._value;
+                        }
+                        cout << _d._class << ',' << _n << ',' << _range << ',' << _d._capacity << ','
+                             << _e.first << ',' << _status << ',';
+                        if (_ok) {
+                            cout << _r._value << ',' << (_r._value == _ref) << ','
+                                 << fixed << setprecision(3) << _r._ms << ',' << _rss_kb << ',' << _r._work;
+                        }
+                        else {
+                            cout << ",,," << _rss_kb << ",";
+                        }
+                        cout << '\n';
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
@@ -5,7 +5,13 @@
 #include <termios.h>
 #include <cmath>
 #include <iomanip>
+#include <fstream>
+#include <cstdint>
+#include <cstdio>
+#include <sys/resource.h>
 
+#include <array>
+#include <string>
 #include <vector>
 #include <queue>
 #include <unordered_set>
@@ -13,6 +19,7 @@
 #include <functional>
 #include <algorithm>
 #include <random>
+#include <memory>
 
 #include <cassert>
 
@@ -25,6 +32,87 @@ enum direct_t {
 
 int getchar_unbuffered();
 
+// moves of the blank on a _N x _N table, generated at compile time.
+// _dir[b][l] lists the legal moves from cell b except the inverse of last move l, _to[b][l] the cells they lead to.
+template <size_t _N> struct move_table_t {
+    static_assert(_N * _N <= 256, "cells must fit in uint8_t");
+    static constexpr size_t _none = 4; // no last move
+    static constexpr std::ptrdiff_t _offset[4] = { // cell offset of the blank, indexed by direct_t
+        std::ptrdiff_t(_N), -std::ptrdiff_t(_N), 1, -1
+    };
+    static constexpr size_t inverse(size_t _d) { return _d ^ 1; } // up <-> down, left <-> right
+    constexpr move_table_t() {
+        for (size_t _b = 0; _b < _N * _N; ++_b) {
+            const size_t _x = _b / _N; const size_t _y = _b % _N;
+            _legal[_b][direct_t::up] = (_x != _N - 1);
+            _legal[_b][direct_t::down] = (_x != 0);
+            _legal[_b][direct_t::left] = (_y != _N - 1);
+            _legal[_b][direct_t::right] = (_y != 0);
+            for (size_t _l = 0; _l <= _none; ++_l) {
+                for (size_t _d = 0; _d < 4; ++_d) {
+                    if (!_legal[_b][_d] || (_l != _none && _d == inverse(_l))) continue;
+                    uint8_t& _c = _count[_b][_l];
+                    _dir[_b][_l][_c] = direct_t(_d);
+                    _to[_b][_l][_c] = uint8_t(std::ptrdiff_t(_b) + _offset[_d]);
+                    ++_c;
+                }
+            }
+        }
+    }
+    bool _legal[_N * _N][4] = {};
+    uint8_t _count[_N * _N][_none + 1] = {};
+    direct_t _dir[_N * _N][_none + 1][4] = {};
+    uint8_t _to[_N * _N][_none + 1][4] = {};
+};
+template <size_t _N> inline constexpr move_table_t<_N> move_table {};
+
+// buffered sequential reader of a file of uint64_t, %_block entries at a time.
+struct rank_file_reader {
+    rank_file_reader(const std::string& _path, size_t _block)
+     : _is(_path, std::ios::binary), _block(std::max<size_t>(_block, 1)) { fill(); }
+    bool ok() const { return _is.is_open() && !_is.bad(); }
+    bool empty() const { return _k == _buf.size(); }
+    uint64_t top() const { return _buf[_k]; }
+    void pop() { if (++_k == _buf.size()) fill(); }
+    void fill() {
+        _buf.resize(_block); _k = 0;
+        if (_is.is_open()) _is.read(reinterpret_cast<char*>(_buf.data()), _buf.size() * sizeof(uint64_t));
+        _buf.resize(_is.is_open() ? _is.gcount() / sizeof(uint64_t) : 0);
+    }
+    std::ifstream _is;
+    size_t _block;
+    std::vector<uint64_t> _buf;
+    size_t _k = 0;
+};
+// buffered writer of a file of uint64_t, close() tells whether everything reached the file.
+struct rank_file_writer {
+    rank_file_writer(const std::string& _path, size_t _block)
+     : _os(_path, std::ios::binary), _block(_block) { _buf.reserve(_block); }
+    bool ok() const { return _os.good(); }
+    void push(uint64_t _r) {
+        _buf.push_back(_r);
+        if (_buf.size() >= _block) flush();
+    }
+    void append(const uint64_t* _p, size_t _n) {
+        flush();
+        _os.write(reinterpret_cast<const char*>(_p), _n * sizeof(uint64_t));
+    }
+    void flush() {
+        if (_buf.empty()) return;
+        _os.write(reinterpret_cast<const char*>(_buf.data()), _buf.size() * sizeof(uint64_t));
+        _buf.clear();
+    }
+    bool close() {
+        flush();
+        if (_os.is_open()) _os.close();
+        else _os.setstate(std::ios::failbit);
+        return !_os.fail();
+    }
+    std::ofstream _os;
+    size_t _block;
+    std::vector<uint64_t> _buf;
+};
+
 template <size_t _N> class table_t {
     typedef unsigned element_type;
     struct point_t {
@@ -39,6 +127,12 @@ public:
     table_t(const table_t<_N>&) = default;
     table_t<_N>& operator=(const table_t<_N>&) = default;
     std::vector<direct_t> n_digital_issue();
+    // breadth-first enumeration of all states reachable from this one, returns the size of each layer.
+    // states are packed into their permutation rank. the 2-bit-per-state table is used when it fits
+    // in %_memory bytes, otherwise layers live in %_dir as sorted rank files with delayed duplicate detection.
+    // if %_dir is given, every layer is left there as "layer_<depth>.bin", sorted native uint64_t ranks.
+    // returns empty if external mode has no %_dir, or a file can't be opened, read or written.
+    std::vector<size_t> enumerate(const std::string& _dir = "", size_t _memory = size_t(1) << 30) const;
     bool solvable() const;
     void demo();
     void shuffle();
@@ -57,12 +151,28 @@ private:
     bool right();
     bool up();
     bool down();
+    bool try_move(direct_t _d);
+    void move(direct_t _d); // %_d must be legal
+    size_t blank() const { return _blank._x * _N + _blank._y; } // cell of blank
+    // calls _f(direct_t, size_t) for each legal move of the blank at cell %_b, with the cell it moves to.
+    // the inverse of %_last is skipped, move_table_t<_N>::_none skips nothing.
+    template <typename _F> static void for_each_move(size_t _b, size_t _last, _F&& _f);
 
     // 可采纳性
     size_t evaluate() const;
     // signature
     size_t signature() const;
 
+    typedef uint64_t rank_type;
+    typedef std::array<element_type, _N * _N> flat_type;
+    flat_type flatten() const;
+    static rank_type rank(const flat_type& _f); // lexicographic rank of permutation
+    static flat_type unrank(rank_type _r);
+    static rank_type states(); // (_N * _N)!
+    template <typename _F> static void successors(rank_type _r, _F&& _f); // _f(rank_type) for each neighbor
+    std::vector<size_t> enumerate_in_memory(const std::string& _dir) const;
+    std::vector<size_t> enumerate_external(const std::string& _dir, size_t _memory) const;
+
     void print() const;
     void clear_print() const;
     bool solved() const { return evaluate() == 0; }
@@ -95,34 +205,29 @@ template <size_t _N> table_t<_N>::table_t(std::initializer_list<std::initializer
     _max_digit_num = (std::log10(_N * _N) + 1);
 }
 
-template <size_t _N> auto table_t<_N>::up() -> bool {
-    if (_blank._x == _N - 1) return false;
-    auto _new_blank = _blank; ++_new_blank._x;
-    std::swap((*this)[_blank], (*this)[_new_blank]);
-    _blank = _new_blank;
-    return true;
-};
-template <size_t _N> auto table_t<_N>::down() -> bool {
-    if (_blank._x == 0) return false;
-    auto _new_blank = _blank; --_new_blank._x;
-    std::swap((*this)[_blank], (*this)[_new_blank]);
-    _blank = _new_blank;
-    return true;
+template <size_t _N> template <typename _F> auto table_t<_N>::for_each_move(size_t _b, size_t _last, _F&& _f) -> void {
+    const auto& _mt = move_table<_N>;
+    const size_t _n = _mt._count[_b][_last];
+    for (size_t _i = 0; _i < _n; ++_i) {
+        _f(_mt._dir[_b][_last][_i], size_t(_mt._to[_b][_last][_i]));
+    }
 };
-template <size_t _N> auto table_t<_N>::left() -> bool {
-    if (_blank._y == _N - 1) return false;
-    auto _new_blank = _blank; ++_new_blank._y;
+template <size_t _N> auto table_t<_N>::move(direct_t _d) -> void {
+    assert(move_table<_N>._legal[blank()][_d]);
+    const size_t _k = blank() + move_table_t<_N>::_offset[_d];
+    const point_t _new_blank(_k / _N, _k % _N);
     std::swap((*this)[_blank], (*this)[_new_blank]);
     _blank = _new_blank;
-    return true;
 };
-template <size_t _N> auto table_t<_N>::right() -> bool {
-    if (_blank._y == 0) return false;
-    auto _new_blank = _blank; --_new_blank._y;
-    std::swap((*this)[_blank], (*this)[_new_blank]);
-    _blank = _new_blank;
+template <size_t _N> auto table_t<_N>::try_move(direct_t _d) -> bool {
+    if (!move_table<_N>._legal[blank()][_d]) return false;
+    move(_d);
     return true;
 };
+template <size_t _N> auto table_t<_N>::up() -> bool { return try_move(direct_t::up); };
+template <size_t _N> auto table_t<_N>::down() -> bool { return try_move(direct_t::down); };
+template <size_t _N> auto table_t<_N>::left() -> bool { return try_move(direct_t::left); };
+template <size_t _N> auto table_t<_N>::right() -> bool { return try_move(direct_t::right); };
 
 #ifdef EULER_DISTANCE_EVALUATE
 template <size_t _N> auto table_t<_N>::evaluate() const -> size_t {
@@ -167,6 +272,7 @@ template <size_t _N> auto table_t<_N>::n_digital_issue()
     struct node {
         node() = delete;
         node(const table_t<_N>& _t) : _t(_t) { _cost = _t.evaluate(); }
+        node(table_t<_N> _t, size_t _step, size_t _cost) : _step(_step), _cost(_cost), _t(std::move(_t)) {}
         node(const node&) = default;
         node& operator=(const node&) = default;
         size_t _step = 0;
@@ -176,13 +282,12 @@ template <size_t _N> auto table_t<_N>::n_digital_issue()
     struct tree_node : node {
         tree_node() = delete;
         tree_node(const table_t<_N>& _t) : node(_t) {}
-        tree_node(const tree_node& _rhs) : node(_rhs) {}
+        tree_node(table_t<_N> _t, size_t _step, size_t _cost) : node(std::move(_t), _step, _cost) {}
+        tree_node(const tree_node&) = delete;
         tree_node& operator=(const tree_node&) = delete;
         tree_node* _parent = nullptr;
-        tree_node* _up = nullptr;
-        tree_node* _down = nullptr;
-        tree_node* _left = nullptr;
-        tree_node* _right = nullptr;
+        tree_node* _child[4] = {}; // indexed by direct_t
+        size_t _last = move_table_t<_N>::_none; // move from %_parent
     };
     std::priority_queue<tree_node*, std::vector<tree_node*>,
                         std::function<bool(const tree_node*, const tree_node*)>>
@@ -190,18 +295,9 @@ template <size_t _N> auto table_t<_N>::n_digital_issue()
                             return _a->_cost > _b->_cost;
                         });
     tree_node _root(*this);
-    auto last_action = [&](const tree_node* const _p, direct_t _dir) -> bool {
-        if (_p->_parent == nullptr) return false;
-        const tree_node* const _pp = _p->_parent;
-        if (_dir == direct_t::up && _p == _pp->_up) return true;
-        if (_dir == direct_t::down && _p == _pp->_down) return true;
-        if (_dir == direct_t::left && _p == _pp->_left) return true;
-        if (_dir == direct_t::right && _p == _pp->_right) return true;
-        return false;
-    };
     auto leaf_node = [&](const tree_node* const _p) -> bool {
         assert(_p != nullptr);
-        return _p->_up == nullptr && _p->_down == nullptr && _p->_left == nullptr && _p->_right == nullptr;
+        return std::all_of(std::begin(_p->_child), std::end(_p->_child), [](const tree_node* _c) { return _c == nullptr; });
     };
     _q.push(&_root);
     std::unordered_map<size_t, size_t> _visited; // {signature, cost}
@@ -220,78 +316,18 @@ template <size_t _N> auto table_t<_N>::n_digital_issue()
             _max_cost = std::min(_max_cost, _s->_cost);
             continue;
         }
-        if (!last_action(_s, direct_t::down)) {
-            tree_node* const _up = new tree_node(*_s);
-            if (_up->_t.up()) {
-                ++_up->_step;
-                _up->_cost = _up->_t.evaluate() + _up->_step;
-                const auto _sign = _up->_t.signature();
-                if ((_visited.count(_sign) && _visited[_sign] < _up->_cost) || _up->_cost >= _max_cost) {
-                    delete _up;
-                }
-                else {
-                    assert(leaf_node(_up));
-                    _up->_parent = _s; _s->_up = _up;
-                    _q.push(_up);
-                    _visited[_sign] = _up->_cost;
-                }
-            }
-            else delete _up; 
-        }
-        if (!last_action(_s, direct_t::up)) {
-            tree_node* const _down = new tree_node(*_s);
-            if (_down->_t.down()) {
-                ++_down->_step;
-                _down->_cost = _down->_t.evaluate() + _down->_step;
-                const auto _sign = _down->_t.signature();
-                if ((_visited.count(_sign) && _visited[_sign] < _down->_cost) || _down->_cost >= _max_cost) {
-                    delete _down;
-                }
-                else {
-                    assert(leaf_node(_down));
-                    _down->_parent = _s; _s->_down = _down;
-                    _q.push(_down);
-                    _visited[_sign] = _down->_cost;
-                }
-            }
-            else delete _down;
-        }
-        if (!last_action(_s, direct_t::right)) {
-            tree_node* const _left = new tree_node(*_s);
-            if (_left->_t.left()) {
-                ++_left->_step;
-                _left->_cost = _left->_t.evaluate() + _left->_step;
-                const auto _sign = _left->_t.signature();
-                if ((_visited.count(_sign) && _visited[_sign] < _left->_cost) || _left->_cost >= _max_cost) {
-                    delete _left;
-                }
-                else {
-                    assert(leaf_node(_left));
-                    _left->_parent = _s; _s->_left = _left;
-                    _q.push(_left);
-                    _visited[_sign] = _left->_cost;
-                }
-            }
-            else delete _left;
-        }
-        if (!last_action(_s, direct_t::left)) {
-            tree_node* const _right = new tree_node(*_s);
-            if (_right->_t.right()) {
-                ++_right->_step;
-                _right->_cost = _right->_t.evaluate() + _right->_step;
-                const auto _sign = _right->_t.signature();
-                if ((_visited.count(_sign) && _visited[_sign] < _right->_cost) || _right->_cost >= _max_cost) {
-                    delete _right;
-                }
-                else {
-                    assert(leaf_node(_right));
-                    _right->_parent = _s; _s->_right = _right;
-                    _q.push(_right);
-                    _visited[_sign] = _right->_cost;
-                }
-            }
-            else delete _right;
-        }
+        // only legal moves that don't undo the last one are generated
+        for_each_move(_s->_t.blank(), _s->_last, [&](direct_t _dir, size_t) {
+            table_t<_N> _t = _s->_t; _t.move(_dir);
+            const size_t _step = _s->_step + 1;
+            const size_t _cost = _t.evaluate() + _step;
+            const auto _sign = _t.signature();
+            if ((_visited.count(_sign) && _visited[_sign] < _cost) || _cost >= _max_cost) return;
+            tree_node* const _c = new tree_node(std::move(_t), _step, _cost);
+            _c->_parent = _s; _c->_last = _dir; _s->_child[_dir] = _c;
+            _q.push(_c);
+            _visited[_sign] = _cost;
+        });
     }
     std::cout << "visited.size() = " << _visited.size() << std::endl;
     if (_target == nullptr) {
@@ -300,31 +336,15 @@ template <size_t _N> auto table_t<_N>::n_digital_issue()
     assert(leaf_node(_target));
     std::vector<direct_t> _path; _path.reserve(_target->_step);
     for (const tree_node* _i = _target; _i != &_root; _i = _i->_parent) {
-        const tree_node* const _ip = _i->_parent;
-        assert(_ip != nullptr);
-        if (_i == _ip->_left) {
-            _path.push_back(direct_t::left);
-        }
-        else if (_i == _ip->_right) {
-            _path.push_back(direct_t::right);
-        }
-        else if (_i == _ip->_up) {
-            _path.push_back(direct_t::up);
-        }
-        else if (_i == _ip->_down) {
-            _path.push_back(direct_t::down);
-        }
-        else {
-            assert(false);
-        }
+        assert(_i->_parent != nullptr && _i->_parent->_child[_i->_last] == _i);
+        _path.push_back(direct_t(_i->_last));
     }
     std::reverse(_path.begin(), _path.end());
     std::function<void(tree_node*)> dfs = [&](tree_node* _p) {
         if (_p == nullptr) return;
-        dfs(_p->_up); _p->_up = nullptr;
-        dfs(_p->_down); _p->_down = nullptr;
-        dfs(_p->_left); _p->_left = nullptr;
-        dfs(_p->_right); _p->_right = nullptr;
+        for (auto& _c : _p->_child) {
+            dfs(_c); _c = nullptr;
+        }
         if (_p != &_root) {
             delete _p;
         }
@@ -333,6 +353,215 @@ template <size_t _N> auto table_t<_N>::n_digital_issue()
     return _path;
 };
 
+template <size_t _N> auto table_t<_N>::flatten() const -> flat_type {
+    flat_type _f;
+    for (size_t _i = 0; _i < _N; ++_i) {
+        for (size_t _j = 0; _j < _N; ++_j) {
+            _f[_i * _N + _j] = _data[_i][_j];
+        }
+    }
+    return _f;
+};
+template <size_t _N> auto table_t<_N>::rank(const flat_type& _f) -> rank_type {
+    rank_type _r = 0;
+    for (size_t _i = 0; _i < _f.size(); ++_i) { // lehmer code as factorial number
+        size_t _less = 0;
+        for (size_t _j = _i + 1; _j < _f.size(); ++_j) {
+            if (_f[_j] < _f[_i]) ++_less;
+        }
+        _r = _r * (_f.size() - _i) + _less;
+    }
+    return _r;
+};
+template <size_t _N> auto table_t<_N>::unrank(rank_type _r) -> flat_type {
+    flat_type _f;
+    std::array<size_t, _N * _N> _digit;
+    for (size_t _i = _f.size(); _i > 0; --_i) {
+        _digit[_i - 1] = _r % (_f.size() - _i + 1);
+        _r /= (_f.size() - _i + 1);
+    }
+    uint32_t _left = (uint32_t(1) << _f.size()) - 1; // unused elements as a bitmask
+    for (size_t _i = 0; _i < _f.size(); ++_i) {
+        uint32_t _m = _left;
+        for (size_t _j = 0; _j < _digit[_i]; ++_j) _m &= _m - 1; // drop the smaller ones
+        const unsigned _e = __builtin_ctz(_m);
+        _f[_i] = _e; _left &= ~(uint32_t(1) << _e);
+    }
+    return _f;
+};
+template <size_t _N> auto table_t<_N>::states() -> rank_type {
+    static_assert(_N * _N <= 20, "(_N * _N)! must fit in rank_type");
+    rank_type _ans = 1;
+    for (size_t _i = 2; _i <= _N * _N; ++_i) _ans *= _i;
+    return _ans;
+};
+template <size_t _N> template <typename _F> auto table_t<_N>::successors(rank_type _r, _F&& _f) -> void {
+    flat_type _t = unrank(_r);
+    const size_t _b = std::find(_t.begin(), _t.end(), 0) - _t.begin();
+    for_each_move(_b, move_table_t<_N>::_none, [&](direct_t, size_t _k) {
+        std::swap(_t[_b], _t[_k]); _f(rank(_t)); std::swap(_t[_b], _t[_k]);
+    });
+};
+
+template <size_t _N> auto table_t<_N>::enumerate(const std::string& _dir, size_t _memory) const
+-> std::vector<size_t> {
+    if ((states() + 3) / 4 <= _memory) {
+        return enumerate_in_memory(_dir);
+    }
+    if (_dir.empty()) return {}; // external mode needs a directory
+    return enumerate_external(_dir, _memory);
+};
+template <size_t _N> auto table_t<_N>::enumerate_in_memory(const std::string& _dir) const
+-> std::vector<size_t> {
+    // 2 bits per state, 3 means unseen, 0 means expanded, 1 and 2 alternate as current and next layer.
+    const rank_type _total = states();
+    std::vector<uint8_t> _table((_total + 3) / 4, 0xff);
+    auto get = [&](rank_type _r) -> unsigned { return (_table[_r >> 2] >> ((_r & 3) << 1)) & 3; };
+    auto set = [&](rank_type _r, unsigned _x) {
+        uint8_t& _byte = _table[_r >> 2]; const unsigned _shift = (_r & 3) << 1;
+        _byte = (_byte & ~(3u << _shift)) | (_x << _shift);
+    };
+    set(rank(flatten()), 1);
+    std::vector<size_t> _layers(1, 1);
+    for (size_t _d = 0; ; ++_d) {
+        const unsigned _cur = 1 + _d % 2; const unsigned _next = 1 + (_d + 1) % 2;
+        std::unique_ptr<rank_file_writer> _os;
+        if (!_dir.empty()) {
+            _os.reset(new rank_file_writer(_dir + "/layer_" + std::to_string(_d) + ".bin", 1 << 13));
+            if (!_os->ok()) return {};
+        }
+        size_t _cnt = 0;
+        for (rank_type _r = 0; _r < _total; ++_r) { // scanning in rank order keeps the layer file sorted
+            if (get(_r) != _cur) continue;
+            if (_os != nullptr) _os->push(_r);
+            successors(_r, [&](rank_type _s) {
+                if (get(_s) == 3) {
+                    set(_s, _next); ++_cnt;
+                }
+            });
+            set(_r, 0);
+        }
+        if (_os != nullptr && !_os->close()) return {};
+        if (_cnt == 0) break;
+        _layers.push_back(_cnt);
+    }
+    return _layers;
+};
+template <size_t _N> auto table_t<_N>::enumerate_external(const std::string& _dir, size_t _memory) const
+-> std::vector<size_t> {
+    auto layer_path = [&](size_t _d) { return _dir + "/layer_" + std::to_string(_d) + ".bin"; };
+    auto run_path = [&](size_t _k) { return _dir + "/run_" + std::to_string(_k) + ".bin"; };
+    // %_memory covers the sort buffer and every stream buffer.
+    const size_t _entries = std::max<size_t>(_memory / sizeof(rank_type), 8);
+    const size_t _block = std::min<size_t>(_entries / 8, 1 << 13); // entries per stream buffer
+    const size_t _chunk = _entries - 2 * _block; // besides the layer reader and the run writer
+    rlimit _rl; getrlimit(RLIMIT_NOFILE, &_rl);
+    const size_t _fds = (_rl.rlim_cur == RLIM_INFINITY ? SIZE_MAX : _rl.rlim_cur);
+    // runs merged at once, besides the writer and the reader of layer %_d-1
+    const size_t _fan_in = std::max<size_t>(std::min<size_t>(_entries / _block - 2, _fds > 18 ? _fds - 16 : 2), 2);
+
+    size_t _run0 = 0; size_t _next_run = 0; // runs of the current layer are [_run0, _next_run)
+    auto fail = [&]() -> std::vector<size_t> {
+        for (size_t _k = _run0; _k < _next_run; ++_k) std::remove(run_path(_k).c_str());
+        return {};
+    };
+    // merge sorted runs %_in into %_out, dropping duplicates and anything in %_prev.
+    auto merge = [&](const std::vector<size_t>& _in, const std::string& _out, const std::string& _prev, size_t& _cnt) -> bool {
+        std::vector<rank_file_reader> _r; _r.reserve(_in.size());
+        for (const auto _k : _in) {
+            _r.emplace_back(run_path(_k), _block);
+            if (!_r.back().ok()) return false;
+        }
+        std::unique_ptr<rank_file_reader> _p(_prev.empty() ? nullptr : new rank_file_reader(_prev, _block));
+        if (_p != nullptr && !_p->ok()) return false;
+        rank_file_writer _w(_out, _block);
+        if (!_w.ok()) return false;
+        std::priority_queue<std::pair<rank_type, size_t>, std::vector<std::pair<rank_type, size_t>>,
+                            std::greater<std::pair<rank_type, size_t>>> _q;
+        for (size_t _k = 0; _k < _r.size(); ++_k) {
+            if (!_r[_k].empty()) _q.emplace(_r[_k].top(), _k);
+        }
+        _cnt = 0; bool _any = false; rank_type _last = 0;
+        while (!_q.empty()) {
+            const auto [_x, _k] = _q.top(); _q.pop();
+            _r[_k].pop();
+            if (!_r[_k].empty()) _q.emplace(_r[_k].top(), _k);
+            if (_any && _x == _last) continue;
+            _any = true; _last = _x;
+            while (_p != nullptr && !_p->empty() && _p->top() < _x) _p->pop();
+            if (_p != nullptr && !_p->empty() && _p->top() == _x) continue;
+            _w.push(_x); ++_cnt;
+        }
+        for (const auto& _i : _r) {
+            if (!_i.ok()) return false;
+        }
+        if (_p != nullptr && !_p->ok()) return false;
+        return _w.close();
+    };
+
+    {
+        rank_file_writer _w(layer_path(0), 1);
+        _w.push(rank(flatten()));
+        if (!_w.close()) return {};
+    }
+    std::vector<size_t> _layers(1, 1);
+    for (size_t _d = 0; ; ++_d) {
+        _run0 = _next_run;
+        // expand layer %_d into sorted, unique runs
+        std::vector<size_t> _runs;
+        std::vector<rank_type> _buf; _buf.reserve(_chunk);
+        bool _ok = true;
+        auto flush = [&]() {
+            if (_buf.empty()) return;
+            std::sort(_buf.begin(), _buf.end());
+            _buf.erase(std::unique(_buf.begin(), _buf.end()), _buf.end());
+            rank_file_writer _w(run_path(_next_run), 0);
+            _runs.push_back(_next_run++);
+            _w.append(_buf.data(), _buf.size());
+            _ok = _ok && _w.close();
+            _buf.clear();
+        };
+        {
+            rank_file_reader _in(layer_path(_d), _block);
+            for (; _ok && _in.ok() && !_in.empty(); _in.pop()) {
+                successors(_in.top(), [&](rank_type _s) {
+                    _buf.push_back(_s);
+                    if (_buf.size() == _chunk) flush();
+                });
+            }
+            if (!_in.ok()) return fail();
+        }
+        flush();
+        if (!_ok) return fail();
+        std::vector<rank_type>().swap(_buf);
+        // merge passes of at most %_fan_in runs, until one pass can finish the layer
+        while (_runs.size() > _fan_in) {
+            std::vector<size_t> _merged;
+            for (size_t _i = 0; _i < _runs.size(); _i += _fan_in) {
+                const std::vector<size_t> _group(_runs.begin() + _i, _runs.begin() + std::min(_i + _fan_in, _runs.size()));
+                size_t _cnt = 0;
+                _merged.push_back(_next_run++);
+                if (!merge(_group, run_path(_merged.back()), "", _cnt)) return fail();
+                for (const auto _k : _group) std::remove(run_path(_k).c_str());
+            }
+            _runs.swap(_merged);
+        }
+        // moving the blank flips its parity, so no neighbor lies in layer %_d itself, only in %_d-1 or %_d+1.
+        size_t _cnt = 0;
+        if (!merge(_runs, layer_path(_d + 1), (_d == 0 ? "" : layer_path(_d - 1)), _cnt)) {
+            std::remove(layer_path(_d + 1).c_str());
+            return fail();
+        }
+        for (const auto _k : _runs) std::remove(run_path(_k).c_str());
+        if (_cnt == 0) {
+            std::remove(layer_path(_d + 1).c_str());
+            break;
+        }
+        _layers.push_back(_cnt);
+    }
+    return _layers;
+};
+
 template <size_t _N> auto table_t<_N>::solvable() const -> bool {
     size_t _tau = ((_blank._x + _blank._y) % 2 == 0 || _N % 2 == 1 ? 0 : 1);
     auto less_cnt = [&](size_t _i, size_t _j) -> size_t {